@@ -0,0 +1,253 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <cerrno>
+#include <cstdlib>
+#include <filesystem>
+#include "KVStorageService.h"
+
+using namespace std;
+
+// Puts may still allocate inside LevelDB: the memtable grabs a new 4KB arena block every few dozen
+// entries and the writer queue grows a node now and then. Anything near one allocation per put
+// means the server's own hot path is allocating again.
+const double MAX_PUT_ALLOCS_PER_REQUEST = 0.1;
+const int NUM_KEYS = 1000;
+const int VALUE_SIZE = 100;
+const int CLIENT_THREADS = 4;
+
+// The run must stay inside one memtable: a rotation creates a new log file and memtable on the
+// writer thread, and reads that fall through to an SSTable allocate block iterators. Each put
+// costs about 140 bytes of memtable; budget 256 to be safe.
+const size_t WRITE_BUFFER_SIZE = 1 << 30;
+const size_t MEMTABLE_BYTES_PER_PUT = 256;
+
+// Allocations made inside the backend's handlers, on whichever thread runs them
+thread_local atomic<long long>* hot_path_counter = nullptr;
+atomic<long long> get_allocs{0};
+atomic<long long> put_allocs{0};
+
+// Every allocation in the process while the measured phase runs, including gRPC and the client
+atomic<bool> counting_all{false};
+atomic<long long> all_allocs{0};
+
+void count_alloc() {
+    if (hot_path_counter) {
+        hot_path_counter->fetch_add(1, memory_order_relaxed);
+    }
+    if (counting_all.load(memory_order_relaxed)) {
+        all_allocs.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+// Count at the malloc level so direct malloc calls and every operator new variant (libstdc++'s
+// forward to malloc/aligned_alloc) are seen. Relies on glibc exporting its __libc_* allocators.
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+
+void* malloc(size_t size) noexcept {
+    count_alloc();
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept {
+    count_alloc();
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) noexcept {
+    count_alloc();
+    return __libc_realloc(ptr, size);
+}
+
+void* memalign(size_t alignment, size_t size) noexcept {
+    count_alloc();
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) noexcept {
+    count_alloc();
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) noexcept {
+    count_alloc();
+    void* ptr = __libc_memalign(alignment, size);
+    if (!ptr) {
+        return ENOMEM;
+    }
+    *out = ptr;
+    return 0;
+}
+}
+
+// Attributes allocations on this thread to one counter for the lifetime of the scope
+class HotPathScope {
+public:
+    explicit HotPathScope(atomic<long long>* counter) { hot_path_counter = counter; }
+    ~HotPathScope() { hot_path_counter = nullptr; }
+};
+
+// The real LevelDB backend with its handlers' allocations counted. Plugged into the real service,
+// so requests still arrive through gRPC, the registered message allocators, Get() inline on the
+// callback thread and Put() through the writer thread.
+class CountingBackend : public KVStorageBackend {
+public:
+    using KVStorageBackend::KVStorageBackend;
+
+    grpc::Status HandleGet(const kvstore::GetRequest& request, kvstore::GetResponse* response) {
+        HotPathScope scope(&get_allocs);
+        return KVStorageBackend::HandleGet(request, response);
+    }
+
+    grpc::Status HandlePut(const kvstore::PutRequest& request, kvstore::PutResponse* response) {
+        HotPathScope scope(&put_allocs);
+        return KVStorageBackend::HandlePut(request, response);
+    }
+};
+
+// Each client owns the keys congruent to its id, so a Get must return the value it just put
+bool run_client(kvstore::KVStore::Stub* stub, const vector<string>& keys, const vector<string>& values,
+                int client_id, int num_requests) {
+    bool ok = true;
+    for (int i = 0; i < num_requests; ++i) {
+        const string& key = keys[(client_id + CLIENT_THREADS * i) % NUM_KEYS];
+        const string& value = values[i % NUM_KEYS];
+
+        kvstore::PutRequest put_request;
+        put_request.set_key(key);
+        put_request.set_value(value);
+        kvstore::PutResponse put_response;
+        grpc::ClientContext put_context;
+        if (!stub->Put(&put_context, put_request, &put_response).ok() || put_response.status() == PUT_FAILURE) {
+            ok = false;
+        }
+
+        kvstore::GetRequest get_request;
+        get_request.set_key(key);
+        kvstore::GetResponse get_response;
+        grpc::ClientContext get_context;
+        if (!stub->Get(&get_context, get_request, &get_response).ok() || get_response.value() != value) {
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+bool run_clients(kvstore::KVStore::Stub* stub, const vector<string>& keys, const vector<string>& values, int num_requests) {
+    atomic<int> failed_clients{0};
+    vector<thread> clients;
+    for (int i = 0; i < CLIENT_THREADS; ++i) {
+        clients.emplace_back([&, i] {
+            if (!run_client(stub, keys, values, i, num_requests)) {
+                failed_clients++;
+            }
+        });
+    }
+    for (thread& client : clients) {
+        client.join();
+    }
+    return failed_clients == 0;
+}
+
+void print_usage(const char* program_name) {
+    std::cerr << "Usage: " << program_name << " <db_path> <num_requests>" << std::endl;
+    std::cerr << "Example: " << program_name << " ./leveldb_alloc 100000" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    string db_path(argv[1]);
+    int num_requests = 0;
+    try {
+        num_requests = std::stoi(argv[2]);
+    } catch (const std::exception&) {
+    }
+    size_t max_requests = WRITE_BUFFER_SIZE / MEMTABLE_BYTES_PER_PUT - NUM_KEYS;
+    if (num_requests < CLIENT_THREADS || static_cast<size_t>(num_requests) > max_requests) {
+        std::cerr << "num_requests must be between " << CLIENT_THREADS << " and " << max_requests
+                  << " to stay inside one memtable" << std::endl;
+        print_usage(argv[0]);
+        return 1;
+    }
+    int requests_per_client = num_requests / CLIENT_THREADS;
+    num_requests = requests_per_client * CLIENT_THREADS;
+
+    // Keys and values are built up front so the measured phase only exercises the server
+    vector<string> keys, values;
+    for (int i = 0; i < NUM_KEYS; ++i) {
+        keys.push_back("allockey" + to_string(i));
+        values.push_back(string(VALUE_SIZE, 'a' + i % 26));
+    }
+
+    std::filesystem::remove_all(db_path);
+    leveldb::Options options;
+    options.write_buffer_size = WRITE_BUFFER_SIZE;
+    KVStorageServiceImpl<CountingBackend> service(db_path, options);
+
+    int port = 0;
+    grpc::ServerBuilder builder;
+    builder.AddListeningPort("127.0.0.1:0", grpc::InsecureServerCredentials(), &port);
+    builder.RegisterService(&service);
+    unique_ptr<grpc::Server> server(builder.BuildAndStart());
+    auto stub = kvstore::KVStore::NewStub(
+        grpc::CreateChannel("127.0.0.1:" + to_string(port), grpc::InsecureChannelCredentials()));
+
+    // Warm up: fill the key space and let pooled messages and string buffers reach full size
+    bool ok = run_clients(stub.get(), keys, values, NUM_KEYS / CLIENT_THREADS);
+    size_t warm_get_holders = service.GetMessageAllocator().HoldersCreated();
+    size_t warm_put_holders = service.PutMessageAllocator().HoldersCreated();
+
+    get_allocs = 0;
+    put_allocs = 0;
+    all_allocs = 0;
+    counting_all = true;
+    ok = run_clients(stub.get(), keys, values, requests_per_client) && ok;
+    counting_all = false;
+    server->Shutdown();
+
+    size_t get_holders = service.GetMessageAllocator().HoldersCreated();
+    size_t put_holders = service.PutMessageAllocator().HoldersCreated();
+    printf("GET: %lld allocations in handlers over %d requests (%.4f per request)\n", get_allocs.load(), num_requests,
+           static_cast<double>(get_allocs) / num_requests);
+    printf("PUT: %lld allocations in handlers over %d requests (%.4f per request)\n", put_allocs.load(), num_requests,
+           static_cast<double>(put_allocs) / num_requests);
+    printf("Process: %.2f allocations per request including gRPC and the client\n",
+           static_cast<double>(all_allocs) / (2 * num_requests));
+    printf("Message holders created: %zu GET, %zu PUT\n", get_holders, put_holders);
+
+    // A holder first created during the measured phase grows its value buffer once on first use
+    long long new_get_holders = get_holders - warm_get_holders;
+    long long new_put_holders = put_holders - warm_put_holders;
+    bool get_ok = get_allocs <= new_get_holders;
+    bool put_ok = static_cast<double>(put_allocs - new_put_holders) / num_requests < MAX_PUT_ALLOCS_PER_REQUEST;
+
+    // Each client has at most one call in flight plus one finished call whose holder gRPC has not
+    // released yet, so reuse keeps each pool at two holders per client
+    size_t max_holders = 2 * CLIENT_THREADS;
+    bool holders_ok = get_holders <= max_holders && put_holders <= max_holders;
+
+    if (!ok) {
+        std::cerr << "Allocation benchmark failed: a request failed or returned the wrong value." << std::endl;
+    }
+    if (!get_ok || !put_ok) {
+        std::cerr << "Allocation benchmark failed: hot path allocates per request." << std::endl;
+    }
+    if (!holders_ok) {
+        std::cerr << "Allocation benchmark failed: message holders are not being reused." << std::endl;
+    }
+    if (!ok || !get_ok || !put_ok || !holders_ok) {
+        return 1;
+    }
+    std::cout << "Allocation benchmark passed!" << std::endl;
+    return 0;
+}
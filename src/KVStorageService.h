@@ -0,0 +1,344 @@
+#ifndef KV_STORAGE_SERVICE_H
+#define KV_STORAGE_SERVICE_H
+
+#include <iostream>
+#include <string>
+#include <cstddef>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <leveldb/db.h>
+#include <leveldb/write_batch.h>
+#include <google/protobuf/arena.h>
+#include <grpcpp/grpcpp.h>
+#include <grpcpp/support/message_allocator.h>
+#include "generated/kvstore.pb.h"
+#include "generated/kvstore.grpc.pb.h"
+
+const int GET_KEY_FOUND = 0;
+const int GET_KEY_NOT_FOUND = -1;
+const int PUT_NO_OLD_VALUE = 1;
+const int PUT_OLD_VALUE_FOUND = 0;
+const int PUT_FAILURE = -1;
+
+// Log helpers stream their parts directly instead of building a temporary string
+template <typename... Parts>
+void LogInfo(const Parts&... parts) {
+    std::cout << "[SERVER INFO] ";
+    (std::cout << ... << parts) << std::endl;
+}
+
+template <typename... Parts>
+void LogError(const Parts&... parts) {
+    std::cerr << "[SERVER ERROR] ";
+    (std::cerr << ... << parts) << std::endl;
+}
+
+// Hands gRPC request/response pairs allocated once on an arena owned by a pooled holder. The arena
+// is never reset: on release the messages are cleared and the holder goes back to the pool, so
+// the next call reuses the messages and the capacity of their string fields. The pool holds at
+// most kMaxPooledHolders holders (otherwise it tracks peak concurrency), and a holder whose
+// messages grew past kMaxRetainedBytes is freed instead of pooled so one large value does not pin
+// its buffers for the life of the server.
+template <class RequestT, class ResponseT>
+class ArenaMessageAllocator : public grpc::MessageAllocator<RequestT, ResponseT> {
+    static const size_t kArenaBlockSize = 1024;
+    static const size_t kMaxRetainedBytes = 4096;
+    static const size_t kMaxPooledHolders = 256;
+
+    class Holder : public grpc::MessageHolder<RequestT, ResponseT> {
+    public:
+        explicit Holder(ArenaMessageAllocator* owner) : owner_(owner), arena_(MakeArenaOptions(block_)) {
+            this->set_request(google::protobuf::Arena::CreateMessage<RequestT>(&arena_));
+            this->set_response(google::protobuf::Arena::CreateMessage<ResponseT>(&arena_));
+        }
+
+        // The request lives as long as the arena; it is recycled together with the response
+        void FreeRequest() override {}
+
+        void Release() override {
+            if (this->request()->ByteSizeLong() + this->response()->ByteSizeLong() > kMaxRetainedBytes) {
+                delete this;
+                return;
+            }
+            this->request()->Clear();
+            this->response()->Clear();
+            owner_->Recycle(this);
+        }
+
+    private:
+        static google::protobuf::ArenaOptions MakeArenaOptions(char* block) {
+            google::protobuf::ArenaOptions options;
+            options.initial_block = block;
+            options.initial_block_size = kArenaBlockSize;
+            return options;
+        }
+
+        ArenaMessageAllocator* owner_;
+        alignas(std::max_align_t) char block_[kArenaBlockSize];
+        google::protobuf::Arena arena_;
+    };
+
+public:
+    ArenaMessageAllocator() {
+        free_.reserve(kMaxPooledHolders);
+    }
+
+    ~ArenaMessageAllocator() {
+        for (Holder* holder : free_) {
+            delete holder;
+        }
+    }
+
+    grpc::MessageHolder<RequestT, ResponseT>* AllocateMessages() override {
+        {
+            std::lock_guard<std::mutex> lock_guard(free_lock_);
+            if (!free_.empty()) {
+                Holder* holder = free_.back();
+                free_.pop_back();
+                return holder;
+            }
+        }
+        holders_created_++;
+        return new Holder(this);
+    }
+
+    // Number of holders ever created; stays near peak concurrency when holders are being reused
+    size_t HoldersCreated() const { return holders_created_.load(); }
+
+private:
+    void Recycle(Holder* holder) {
+        {
+            std::lock_guard<std::mutex> lock_guard(free_lock_);
+            if (free_.size() < kMaxPooledHolders) {
+                free_.push_back(holder);
+                return;
+            }
+        }
+        delete holder;
+    }
+
+    std::mutex free_lock_;
+    std::vector<Holder*> free_;
+    std::atomic<size_t> holders_created_{0};
+};
+
+// Runs every Put on one server-owned thread: gRPC's callback threads must not block on a LevelDB
+// write stall, and Puts were already serialized by a single lock. Neither the standard library nor
+// gRPC's callback API offers an executor, and wrapping each task in std::function would allocate,
+// so this is a plain queue of fixed-size tasks. The writer takes everything queued in one swap and
+// is only woken when the queue goes from empty to non-empty, so under load a Put costs a lock and
+// no wake-up. Both vectors keep their capacity, so queueing does not allocate below peak depth.
+template <class Task>
+class SerialWorker {
+    static const size_t kReservedTasks = 1024;
+
+public:
+    explicit SerialWorker(std::function<void(const Task&)> handler) : handler_(std::move(handler)) {
+        pending_.reserve(kReservedTasks);
+        draining_.reserve(kReservedTasks);
+        thread_ = std::thread([this] { Run(); });
+    }
+
+    ~SerialWorker() {
+        Shutdown();
+    }
+
+    void Push(const Task& task) {
+        bool was_empty;
+        {
+            std::lock_guard<std::mutex> lock_guard(lock_);
+            was_empty = pending_.empty();
+            pending_.push_back(task);
+        }
+        if (was_empty) {
+            ready_.notify_one();
+        }
+    }
+
+    // Runs every queued task, then stops the thread
+    void Shutdown() {
+        {
+            std::lock_guard<std::mutex> lock_guard(lock_);
+            stopping_ = true;
+        }
+        ready_.notify_one();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+private:
+    void Run() {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock_guard(lock_);
+                ready_.wait(lock_guard, [this] { return stopping_ || !pending_.empty(); });
+                if (pending_.empty()) {
+                    return;
+                }
+                pending_.swap(draining_);
+            }
+            for (const Task& task : draining_) {
+                handler_(task);
+            }
+            draining_.clear();
+        }
+    }
+
+    std::function<void(const Task&)> handler_;
+    std::mutex lock_;
+    std::condition_variable ready_;
+    std::vector<Task> pending_;
+    std::vector<Task> draining_;
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+// One pending Put handed from a gRPC callback thread to the writer
+template <class RequestT, class ResponseT>
+struct DbCall {
+    grpc::ServerUnaryReactor* reactor;
+    const RequestT* request;
+    ResponseT* response;
+};
+
+// LevelDB side of the service: turns requests into responses, independent of how gRPC calls it
+class KVStorageBackend {
+
+    // unordered_map<string, shared_ptr<shared_mutex>> key_locks;
+    leveldb::DB* db_;
+    leveldb::WriteBatch put_batch_;  // reused by every Put; Puts never run concurrently
+
+public:
+    KVStorageBackend(const std::string& db_path, leveldb::Options options) {
+        options.create_if_missing = true;
+        leveldb::Status status = leveldb::DB::Open(options, db_path, &db_);
+        if (!status.ok()) {
+            LogError("Unable to open/create database ", db_path);
+            LogError(status.ToString());
+            exit(1);
+        }
+    }
+
+    ~KVStorageBackend() {
+        delete db_;
+    }
+
+    // Callers must not run two Puts at once
+    grpc::Status HandlePut(const kvstore::PutRequest& request, kvstore::PutResponse* response) {
+        // LogInfo("PUT request received. Key: ", request.key(), ", Value: ", request.value());
+
+        // get the old value straight into the response
+        auto status = DbGet(request.key(), response->mutable_old_value());
+
+        if (status.IsNotFound()) {
+            // key not found, return status 1
+            response->clear_old_value();
+            response->set_status(PUT_NO_OLD_VALUE);
+        } else if (status.ok()) {
+            // found key, old value is already in the response, return status 0
+            response->set_status(PUT_OLD_VALUE_FOUND);
+        } else {
+            // error in retrieving key (e.g., I/O error), return status -1
+            response->set_status(PUT_FAILURE);
+            return grpc::Status::CANCELLED;
+        }
+
+        // write the new value
+        status = DbPut(request.key(), request.value());
+        if (!status.ok()) {
+            LogError("PUT failed for key: ", request.key());
+            response->set_status(PUT_FAILURE);
+            return grpc::Status::CANCELLED;
+        }
+
+        // LogInfo("PUT successful for key: ", request.key());
+        return grpc::Status::OK;
+    }
+
+    grpc::Status HandleGet(const kvstore::GetRequest& request, kvstore::GetResponse* response) {
+        // LogInfo("GET request received. Key: ", request.key());
+
+        // read the value straight into the response
+        auto status = DbGet(request.key(), response->mutable_value());
+
+        if (status.IsNotFound()) {
+            // key not found, return status -1
+            response->clear_value();
+            response->set_status(GET_KEY_NOT_FOUND);
+            // LogInfo("Key not found: ", request.key());
+            return grpc::Status::OK;
+        } else if (status.ok()) {
+            // found key, value is already in the response, return status 0
+            response->set_status(GET_KEY_FOUND);
+            // LogInfo("GET successful. Key: ", request.key(), ", Value: ", response->value());
+            return grpc::Status::OK;
+        } else {
+            // error in retrieving key (e.g., I/O error), return status -1
+            response->clear_value();
+            response->set_status(GET_KEY_NOT_FOUND);
+            // LogError("Failed to retrieve key: ", request.key());
+            return grpc::Status::CANCELLED;
+        }
+    }
+
+private:
+    leveldb::Status DbPut(const std::string& key, const std::string& value) {
+        // Clear keeps the batch's buffer, so steady-state puts do not allocate a new one
+        leveldb::WriteOptions options;
+        put_batch_.Clear();
+        put_batch_.Put(key, value);
+        return db_->Write(options, &put_batch_);
+    }
+
+    leveldb::Status DbGet(const std::string& key, std::string* value) {
+        leveldb::ReadOptions options;
+        return db_->Get(options, key, value);
+    }
+};
+
+// Gets run inline on gRPC's callback thread: a memtable or block-cache read is short and does not
+// wait on other requests, so a handoff would cost more than it saves. Gets that miss the block
+// cache do read from disk on that thread. Puts can stall behind LevelDB compaction and go to the
+// writer thread.
+template <class Backend = KVStorageBackend>
+class KVStorageServiceImpl final : public kvstore::KVStore::CallbackService {
+    using GetAllocator = ArenaMessageAllocator<kvstore::GetRequest, kvstore::GetResponse>;
+    using PutAllocator = ArenaMessageAllocator<kvstore::PutRequest, kvstore::PutResponse>;
+    using PutCall = DbCall<kvstore::PutRequest, kvstore::PutResponse>;
+
+    Backend backend_;
+    GetAllocator get_allocator_;
+    PutAllocator put_allocator_;
+    // Declared last so it is destroyed first, finishing queued Puts while the database is open
+    SerialWorker<PutCall> put_worker_;
+
+public:
+    KVStorageServiceImpl(const std::string& db_path, leveldb::Options options = leveldb::Options())
+        : backend_(db_path, options),
+          put_worker_([this](const PutCall& call) { call.reactor->Finish(backend_.HandlePut(*call.request, call.response)); }) {
+        SetMessageAllocatorFor_Get(&get_allocator_);
+        SetMessageAllocatorFor_Put(&put_allocator_);
+    }
+
+    grpc::ServerUnaryReactor* Put(grpc::CallbackServerContext* context, const kvstore::PutRequest* request, kvstore::PutResponse* response) override {
+        grpc::ServerUnaryReactor* reactor = context->DefaultReactor();
+        put_worker_.Push(PutCall{reactor, request, response});
+        return reactor;
+    }
+
+    grpc::ServerUnaryReactor* Get(grpc::CallbackServerContext* context, const kvstore::GetRequest* request, kvstore::GetResponse* response) override {
+        grpc::ServerUnaryReactor* reactor = context->DefaultReactor();
+        reactor->Finish(backend_.HandleGet(*request, response));
+        return reactor;
+    }
+
+    const GetAllocator& GetMessageAllocator() const { return get_allocator_; }
+    const PutAllocator& PutMessageAllocator() const { return put_allocator_; }
+};
+
+#endif // KV_STORAGE_SERVICE_H
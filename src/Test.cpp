@@ -11,6 +11,8 @@
 #include <sys/wait.h>   
 #include "739kv.h"
 #include <vector>
+#include <atomic>
+#include <algorithm>
 
 #define ASSERT_WITH_CLEANUP(condition, cleanup_action) \
     do { \
@@ -28,6 +30,15 @@ const int PUT_NO_OLD_VALUE = 1;
 const int PUT_OLD_VALUE_FOUND = 0;
 const int PUT_FAILURE = -1;
 
+// Recovery benchmark parameters
+const int RECOVERY_VALUE_SIZE = 100;
+const auto RECOVERY_BASELINE_WINDOW = std::chrono::seconds(1);
+const auto RECOVERY_STEADY_WINDOW = std::chrono::milliseconds(100);
+const double RECOVERY_STEADY_FRACTION = 0.9;  // fraction of pre-crash throughput that counts as steady state
+const auto RECOVERY_TIMEOUT = std::chrono::seconds(60);
+const auto RECOVERY_WRITER_EXIT_WAIT = std::chrono::seconds(5);
+const int RECOVERY_MAX_KEYS = 10000000;  // largest scaled database, preloaded one put at a time
+
 // clean up database
 void clear_db(const std::string& db_path) {
     try {
@@ -39,7 +50,8 @@ void clear_db(const std::string& db_path) {
     }
 }
 
-void start_server(const std::string& server_executable, const std::string& server_addr, const std::string& db_path) {
+void start_server(const std::string& server_executable, const std::string& server_addr, const std::string& db_path,
+                  std::chrono::milliseconds startup_wait = std::chrono::seconds(2)) {
     pid_t pid = fork();
     if (pid == 0) {
         // Child process: start the server
@@ -52,7 +64,7 @@ void start_server(const std::string& server_executable, const std::string& serve
         server_pid = pid;
         std::cout << "Server started with PID: " << server_pid << std::endl;
         // Give the server time to start up
-        std::this_thread::sleep_for(std::chrono::seconds(2));
+        std::this_thread::sleep_for(startup_wait);
     } else {
         // Fork failed
         std::cerr << "Failed to fork process to start server." << std::endl;
@@ -249,13 +261,197 @@ void test_multiple_clients(const std::string& server_executable, const std::stri
     stop_server();
 }
 
+// Value written by the recovery benchmark, padded so every write has the same size
+std::string recovery_value(const std::string& prefix, long long seq) {
+    std::string value = prefix + std::to_string(seq);
+    value.resize(RECOVERY_VALUE_SIZE, 'x');
+    return value;
+}
+
+// State shared between the recovery benchmark and its background writer
+struct RecoveryLoad {
+    std::atomic<bool> stop{false};
+    std::atomic<long long> acked{0};           // number of acknowledged writes so far
+    std::atomic<long long> lost{0};            // acknowledged writes the server no longer had
+    std::atomic<bool> writer_done{false};
+    std::vector<std::string> expected;         // last acknowledged value per key, owned by the writer
+};
+
+// Sustained write load: overwrite the key space in order, retrying each write until it is acknowledged
+void recovery_writer(const std::string& server_addr, RecoveryLoad* load) {
+    long long num_keys = load->expected.size();
+    char old_value[256];
+
+    for (long long seq = 0; !load->stop.load(); ++seq) {
+        std::string key = "recoverykey" + std::to_string(seq % num_keys);
+        std::string value = recovery_value("write", seq);
+        std::string& expected = load->expected[seq % num_keys];
+
+        int status = kv739_put(const_cast<char*>(key.c_str()), const_cast<char*>(value.c_str()), old_value);
+        while (status != PUT_OLD_VALUE_FOUND && status != PUT_NO_OLD_VALUE) {
+            if (load->stop.load()) {
+                // Benchmark gave up on the server; this write was never acknowledged
+                return;
+            }
+            // Server is down: reconnect with a fresh channel so we don't sit in gRPC's reconnect backoff
+            kv739_shutdown();
+            kv739_init(const_cast<char*>(server_addr.c_str()));
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            status = kv739_put(const_cast<char*>(key.c_str()), const_cast<char*>(value.c_str()), old_value);
+        }
+
+        // The old value must be the last acknowledged one, or our own value if a failed attempt was applied
+        if (status != PUT_OLD_VALUE_FOUND || (expected != old_value && value != old_value)) {
+            std::cerr << "Acknowledged write lost for key " << key << ": expected '" << expected
+                      << "', server returned '" << old_value << "'" << std::endl;
+            load->lost++;
+        }
+        expected = value;
+        load->acked++;
+    }
+}
+
+// Give up if the server never comes back. kv739_put has no deadline, so a writer stuck on a
+// server that accepted the connection but never answers is released by killing the server. If
+// the writer still does not finish, skip the join and leave with _exit so no static destructor
+// races it inside the global gRPC client.
+void check_recovery_timeout(std::chrono::steady_clock::time_point crash_time, RecoveryLoad* load, std::thread* writer) {
+    if (std::chrono::steady_clock::now() - crash_time > RECOVERY_TIMEOUT) {
+        std::cerr << "Server did not recover within " << RECOVERY_TIMEOUT.count() << " seconds." << std::endl;
+        load->stop = true;
+        stop_server();
+
+        auto give_up_time = std::chrono::steady_clock::now() + RECOVERY_WRITER_EXIT_WAIT;
+        while (!load->writer_done.load() && std::chrono::steady_clock::now() < give_up_time) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (!load->writer_done.load()) {
+            std::cerr << "Writer is stuck in a request, exiting without joining it." << std::endl;
+            writer->detach();
+            _exit(1);
+        }
+        writer->join();
+        kv739_shutdown();
+        exit(1);
+    }
+}
+
+void print_distribution(const std::string& name, std::vector<double> samples) {
+    if (samples.empty()) {
+        return;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&](double p) {
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()))];
+    };
+    double sum = 0;
+    for (double sample : samples) {
+        sum += sample;
+    }
+    printf("%-26s min %9.2f  p50 %9.2f  p90 %9.2f  p99 %9.2f  max %9.2f  mean %9.2f\n", name.c_str(),
+           samples.front(), percentile(0.5), percentile(0.9), percentile(0.99), samples.back(), sum / samples.size());
+}
+
+// Repeatedly SIGKILL the server under sustained write load and measure how long it takes to recover
+void test_recovery_benchmark(const std::string& server_executable, const std::string& server_addr, const std::string& db_path, int num_keys, int num_cycles) {
+    std::cout << std::endl;
+    std::cout << "**************************************************" << std::endl;
+    std::cout << "Starting recovery benchmark with " << num_keys << " keys and " << num_cycles << " crash cycles..." << std::endl;
+
+    start_server(server_executable, server_addr, db_path);
+    int init_status = kv739_init(const_cast<char*>(server_addr.c_str()));
+    ASSERT_WITH_CLEANUP(init_status == 0, stop_server(); exit(1));
+
+    // Step 1: Load the database up to the requested size
+    RecoveryLoad load;
+    load.expected.resize(num_keys);
+    auto preload_start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_keys; ++i) {
+        load.expected[i] = recovery_value("init", i);
+        test_put("recoverykey" + std::to_string(i), load.expected[i], "", PUT_NO_OLD_VALUE);
+    }
+    printf("Preloaded %d keys in %.2f s\n", num_keys,
+           std::chrono::duration<double>(std::chrono::steady_clock::now() - preload_start).count());
+
+    // Step 2: Crash the server repeatedly while the writer keeps it busy
+    std::thread writer([&] {
+        recovery_writer(server_addr, &load);
+        load.writer_done = true;
+    });
+    std::vector<double> first_request_ms, steady_state_ms, lost_throughput_ops;
+
+    for (int cycle = 1; cycle <= num_cycles; ++cycle) {
+        long long baseline_start = load.acked.load();
+        std::this_thread::sleep_for(RECOVERY_BASELINE_WINDOW);
+        double baseline_rate = (load.acked.load() - baseline_start) /
+                               std::chrono::duration<double>(RECOVERY_BASELINE_WINDOW).count();
+
+        stop_server();
+        auto crash_time = std::chrono::steady_clock::now();
+        long long acked_at_crash = load.acked.load();
+        start_server(server_executable, server_addr, db_path, std::chrono::milliseconds(0));
+
+        // Time to first successful request
+        while (load.acked.load() == acked_at_crash) {
+            check_recovery_timeout(crash_time, &load, &writer);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        double first_request = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - crash_time).count();
+
+        // Time back to steady state: first window whose throughput reaches the pre-crash baseline
+        double window_secs = std::chrono::duration<double>(RECOVERY_STEADY_WINDOW).count();
+        while (true) {
+            long long window_start = load.acked.load();
+            std::this_thread::sleep_for(RECOVERY_STEADY_WINDOW);
+            if ((load.acked.load() - window_start) / window_secs >= RECOVERY_STEADY_FRACTION * baseline_rate) {
+                break;
+            }
+            check_recovery_timeout(crash_time, &load, &writer);
+        }
+        double steady_state = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - crash_time).count();
+
+        // Writes we would have completed at the baseline rate minus the writes actually completed
+        double lost_throughput = baseline_rate * steady_state / 1000.0 - (load.acked.load() - acked_at_crash);
+
+        printf("Recovery cycle %d: baseline %.0f ops/s, first request %.2f ms, steady state %.2f ms, lost %.0f ops\n",
+               cycle, baseline_rate, first_request, steady_state, lost_throughput);
+        first_request_ms.push_back(first_request);
+        steady_state_ms.push_back(steady_state);
+        lost_throughput_ops.push_back(lost_throughput);
+    }
+
+    load.stop = true;
+    writer.join();
+
+    // Step 3: Every acknowledged write must still be readable
+    ASSERT_WITH_CLEANUP(load.lost.load() == 0, stop_server(); exit(1));
+    for (int i = 0; i < num_keys; ++i) {
+        test_get("recoverykey" + std::to_string(i), load.expected[i], GET_KEY_FOUND);
+    }
+
+    std::cout << std::endl;
+    std::cout << "Recovery distribution over " << num_cycles << " cycles (" << num_keys << " keys, "
+              << load.acked.load() << " acknowledged writes):" << std::endl;
+    print_distribution("time to first request (ms)", first_request_ms);
+    print_distribution("time to steady state (ms)", steady_state_ms);
+    print_distribution("throughput lost (ops)", lost_throughput_ops);
+
+    kv739_shutdown();
+    stop_server();
+
+    std::cout << "Recovery benchmark passed!" << std::endl;
+}
+
 void print_usage(const char* program_name) {
     std::cerr << "Usage: " << program_name << " <server_executable> <client_executable> <server_address> <db_path> <num_clients> <num_operations>" << std::endl;
+    std::cerr << "       " << program_name << " <server_executable> <client_executable> <server_address> <db_path> <num_clients> <num_operations> recovery <num_cycles>" << std::endl;
     std::cerr << "Example: " << program_name << " ./server ./client 0.0.0.0:5001 ./leveldb 5 1000" << std::endl;
+    std::cerr << "Example: " << program_name << " ./server ./client 0.0.0.0:5001 ./leveldb 5 1000 recovery 20" << std::endl;
 }
 
 int main(int argc, char* argv[]) {
-    if (argc != 7) {
+    bool recovery_mode = argc == 9 && std::string(argv[7]) == "recovery";
+    if (argc != 7 && !recovery_mode) {
         print_usage(argv[0]);
         return 1;
     }
@@ -271,6 +467,29 @@ int main(int argc, char* argv[]) {
     std::cout << "Server Address: " << server_addr << std::endl;
     std::cout << "Database Path: " << db_path << std::endl;
 
+    if (recovery_mode) {
+        // Recovery benchmark: scale the database from num_operations keys up by 10x and 100x
+        int num_cycles = 0;
+        try {
+            num_cycles = std::stoi(argv[8]);
+        } catch (const std::exception&) {
+        }
+        if (num_cycles < 1) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        if (num_operations < 1 || num_operations > RECOVERY_MAX_KEYS / 100) {
+            std::cerr << "num_operations must be between 1 and " << RECOVERY_MAX_KEYS / 100
+                      << " in recovery mode (the largest run preloads 100x that many keys)" << std::endl;
+            return 1;
+        }
+        for (int num_keys : {num_operations, num_operations * 10, num_operations * 100}) {
+            clear_db(db_path);
+            test_recovery_benchmark(server_executable, server_addr, db_path, num_keys, num_cycles);
+        }
+        return 0;
+    }
+
     clear_db(db_path);
     test_correctness(server_executable, server_addr, db_path, num_operations);
     